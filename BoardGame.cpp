@@ -3,7 +3,9 @@
 //
 
 #include "BoardGame.h"
-#include <SDL_image.h>
+
+#include <algorithm>
+#include <cstdlib>
 
 BoardGame::BoardGame()
 {
@@ -46,166 +48,375 @@ bool BoardGame::setDragged(const Position &pos) {
 }
 
 bool BoardGame::makeMove(const Move &move) {
+    if (!make(move))
+        return false;
+    if (_result != GameResult::IN_PROGRESS)
+    {
+        auto result = _result;
+        resetGame();
+        _lastResult = result;
+    }
+    else
+    {
+        _lastResult = GameResult::IN_PROGRESS;
+    }
+    return true;
+}
+
+bool BoardGame::make(const Move &move) {
     auto from = move.first, to = move.second;
+    if (_result != GameResult::IN_PROGRESS)
+        return false;
     if (!from.valid() || !to.valid())
         return false;
     // Move can only be made 1 step at a time horizontally or vertically
     if (abs(from.x - to.x) + abs(from.y - to.y) != 1)
         return false;
-    if (_board[from.x][from.y] == _turnOrder && _board[to.x][to.y] == SquareState::EMPTY)
-    {
-        _board[to.x][to.y] = _board[from.x][from.y];
-        _board[from.x][from.y] = SquareState::EMPTY;
-        bool over = _turnOrder == SquareState::BLACK_PAWN ? isGameOverBlack() : isGameOverWhite();
-        if (over)
-            resetGame();
-        else
-            _turnOrder = _turnOrder == SquareState::BLACK_PAWN ? SquareState::WHITE_PAWN : SquareState::BLACK_PAWN;
-        return true;
+    if (_board[from.x][from.y] != _turnOrder || _board[to.x][to.y] != SquareState::EMPTY)
+        return false;
+
+    auto mover = _turnOrder;
+    // New move discards the redo tail
+    _history.resize(_historyLength);
+    _history.push_back({move, _hash, _noProgress, {_bestDistance[0], _bestDistance[1]}});
+    ++_historyLength;
+    applyMove(move);
+    updateProgress(mover);
+    _result = evaluate(mover);
+    return true;
+}
+
+GameResult BoardGame::evaluate(SquareState mover) const
+{
+    if (mover == SquareState::BLACK_PAWN ? isGameOverBlack() : isGameOverWhite())
+        return mover == SquareState::BLACK_PAWN ? GameResult::BLACK_WON : GameResult::WHITE_WON;
+    if (repetitions() >= REPETITION_LIMIT)
+        return GameResult::DRAW_REPETITION;
+    if (_noProgress >= NO_PROGRESS_LIMIT)
+        return GameResult::DRAW_NO_PROGRESS;
+    if (!hasLegalMoves())
+        return GameResult::DRAW_NO_MOVES;
+    return GameResult::IN_PROGRESS;
+}
+
+//! Zobrist keys: one per square and pawn color, and one for black taking action
+struct ZobristKeys
+{
+    uint64_t pawn[64][2];
+    uint64_t blackTurn;
+};
+
+//! SplitMix64 generator, advances state
+static constexpr uint64_t splitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static constexpr ZobristKeys makeZobristKeys()
+{
+    ZobristKeys keys = {};
+    uint64_t state = 0x5D6C4B3A29180716ull;
+    for (auto &square : keys.pawn)
+    {
+        square[0] = splitMix64(state);
+        square[1] = splitMix64(state);
     }
-    return false;
+    keys.blackTurn = splitMix64(state);
+    return keys;
 }
 
-bool BoardGame::isGameOverWhite() const
+static constexpr ZobristKeys ZOBRIST = makeZobristKeys();
+
+//! Bitboard bit of square at pos
+static uint64_t squareBit(const Position &pos)
 {
-    for (int i = 0; i < 3; ++i)
+    return 1ull << (pos.x * 8 + pos.y);
+}
+
+//! Zobrist key of a pawn at pos
+static uint64_t pawnKey(SquareState pawn, const Position &pos)
+{
+    return ZOBRIST.pawn[pos.x * 8 + pos.y][pawn == SquareState::BLACK_PAWN];
+}
+
+//! Steps a pawn at pos needs to enter opponent's starting area
+static int goalDistance(SquareState pawn, const Position &pos)
+{
+    if (pawn == SquareState::WHITE_PAWN)
+        return std::max(0, pos.x - 2) + std::max(0, pos.y - 2);
+    return std::max(0, 5 - pos.x) + std::max(0, 5 - pos.y);
+}
+
+void BoardGame::applyMove(const Move &move)
+{
+    auto from = move.first, to = move.second;
+    auto pawn = _board[from.x][from.y];
+    _board[to.x][to.y] = pawn;
+    _board[from.x][from.y] = SquareState::EMPTY;
+    _turnOrder = _turnOrder == SquareState::BLACK_PAWN ? SquareState::WHITE_PAWN : SquareState::BLACK_PAWN;
+    ++_revision;
+
+    _hash ^= pawnKey(pawn, from) ^ pawnKey(pawn, to) ^ ZOBRIST.blackTurn;
+    _pawns[pawn == SquareState::BLACK_PAWN] ^= squareBit(from) | squareBit(to);
+    _distance[pawn == SquareState::BLACK_PAWN] += goalDistance(pawn, to) - goalDistance(pawn, from);
+}
+
+void BoardGame::updateProgress(SquareState mover)
+{
+    int side = mover == SquareState::BLACK_PAWN;
+    if (_distance[side] < _bestDistance[side])
     {
-        for (int j = 0; j < 3; ++j)
-        {
-            if (_board[i][j] != SquareState::WHITE_PAWN)
-                return false;
-        }
+        _bestDistance[side] = _distance[side];
+        _noProgress = 0;
+    }
+    else
+    {
+        ++_noProgress;
     }
-    return true;
 }
 
-bool BoardGame::isGameOverBlack() const
+bool BoardGame::hasLegalMoves() const
 {
-    for (int i = 5; i < 8; ++i)
+    // Bits with y == 7 and y == 0 would wrap to the neighbouring column when stepping down or up
+    const uint64_t lastRow = 0x8080808080808080ull, firstRow = 0x0101010101010101ull;
+    uint64_t pawns = _pawns[_turnOrder == SquareState::BLACK_PAWN];
+    uint64_t empty = ~(_pawns[0] | _pawns[1]);
+    uint64_t steps = (pawns & ~lastRow) << 1 | (pawns & ~firstRow) >> 1 | pawns << 8 | pawns >> 8;
+    return (steps & empty) != 0;
+}
+
+int BoardGame::repetitions() const
+{
+    // Repetitions only count since the last progress, which also keeps the scan short.
+    // Positions with the same player taking action are two moves apart
+    int count = 1;
+    size_t window = std::min((size_t)_noProgress, _historyLength);
+    for (size_t back = 2; back <= window; back += 2)
     {
-        for (int j = 5; j < 8; ++j)
-        {
-            if (_board[i][j] != SquareState::BLACK_PAWN)
-                return false;
-        }
+        if (_history[_historyLength - back].hash == _hash)
+            ++count;
     }
+    return count;
+}
+
+bool BoardGame::undo()
+{
+    if (!canUndo())
+        return false;
+    const auto &record = _history[--_historyLength];
+    // Reverse move is applied the same way, it also passes the turn back
+    applyMove({record.move.second, record.move.first});
+    _noProgress = record.noProgress;
+    _bestDistance[0] = record.bestDistance[0];
+    _bestDistance[1] = record.bestDistance[1];
+    // Moves are never made from finished positions
+    _result = GameResult::IN_PROGRESS;
     return true;
 }
 
-void BoardGame::resetGame() {
+bool BoardGame::redo()
+{
+    if (!canRedo())
+        return false;
+    // Moves in history are already validated
+    auto mover = _turnOrder;
+    applyMove(_history[_historyLength++].move);
+    updateProgress(mover);
+    _result = evaluate(mover);
+    return true;
+}
+
+GameSnapshot BoardGame::snapshot() const
+{
+    GameSnapshot snapshot = {};
+    std::copy(&_board[0][0], &_board[0][0] + 64, &snapshot.board[0][0]);
+    snapshot.selectedField = _selectedField;
+    snapshot.draggedField = _draggedField;
+    snapshot.drawSelection = _drawSelection;
+    snapshot.dragged = _dragged;
+    snapshot.turnOrder = _turnOrder;
+    snapshot.result = _result;
+    snapshot.hash = _hash;
+    snapshot.pawns[0] = _pawns[0];
+    snapshot.pawns[1] = _pawns[1];
+    snapshot.distance[0] = _distance[0];
+    snapshot.distance[1] = _distance[1];
+    snapshot.bestDistance[0] = _bestDistance[0];
+    snapshot.bestDistance[1] = _bestDistance[1];
+    snapshot.noProgress = _noProgress;
+    return snapshot;
+}
+
+void BoardGame::restore(const GameSnapshot &snapshot)
+{
+    std::copy(&snapshot.board[0][0], &snapshot.board[0][0] + 64, &_board[0][0]);
+    _selectedField = snapshot.selectedField;
+    _draggedField = snapshot.draggedField;
+    _drawSelection = snapshot.drawSelection;
+    _dragged = snapshot.dragged;
+    _turnOrder = snapshot.turnOrder;
+    _result = snapshot.result;
+    _hash = snapshot.hash;
+    _pawns[0] = snapshot.pawns[0];
+    _pawns[1] = snapshot.pawns[1];
+    _distance[0] = snapshot.distance[0];
+    _distance[1] = snapshot.distance[1];
+    _bestDistance[0] = snapshot.bestDistance[0];
+    _bestDistance[1] = snapshot.bestDistance[1];
+    _noProgress = snapshot.noProgress;
+    ++_revision;
+    _history.clear();
+    _historyLength = 0;
+}
+
+void BoardGame::setPosition(const SquareState (&board)[8][8], SquareState turnOrder)
+{
+    std::copy(&board[0][0], &board[0][0] + 64, &_board[0][0]);
+    _turnOrder = turnOrder;
+    ++_revision;
+    _history.clear();
+    _historyLength = 0;
+    resetTracking();
+}
+
+void BoardGame::setMirrored(const BoardGame &game)
+{
+    SquareState board[8][8];
     for (int i = 0; i < 8; ++i)
     {
         for (int j = 0; j < 8; ++j)
         {
-            if (i < 3 && j < 3)
-                _board[i][j] = SquareState::BLACK_PAWN;
-            else if (i > 4 && j > 4)
-                _board[i][j] = SquareState::WHITE_PAWN;
-            else
-                _board[i][j] = SquareState::EMPTY;
+            auto state = game.at(mirrored({i, j}));
+            if (state == SquareState::WHITE_PAWN)
+                state = SquareState::BLACK_PAWN;
+            else if (state == SquareState::BLACK_PAWN)
+                state = SquareState::WHITE_PAWN;
+            board[i][j] = state;
         }
     }
-    _turnOrder = SquareState::WHITE_PAWN;
-    _draggedField = {-1, -1};
-    _drawSelection = false;
-    _dragged = false;
-}
-
-BoardRenderer::BoardRenderer(BoardGame *game, SDL_Renderer *renderer) :
-    _game(game),
-    _renderer(renderer)
-{
-    _boardTexture = loadTexture("chessboard.png");
-    _black = loadTexture("blackpawn.png");
-    _white = loadTexture("whitepawn.png");
-    _active = loadTexture("border.png");
+    setPosition(board, game.turnOrder() == SquareState::WHITE_PAWN ? SquareState::BLACK_PAWN : SquareState::WHITE_PAWN);
 }
 
-void BoardRenderer::render()
+std::vector<Move> BoardGame::legalMoves() const
 {
-    SDL_RenderClear(_renderer);
-    // Render board texture to screen
-    SDL_RenderCopy(_renderer, _boardTexture, nullptr, nullptr);
-    // Get window width and height
-    int w, h;
-    SDL_GetRendererOutputSize(_renderer, &w, &h);
-    // float square sizes to avoid multiplication error
-    double sw = w * 0.125, sh = h * 0.125;
-
-    // Render pieces
+    std::vector<Move> moves;
+    Position directions[4] {{0,1},{1,0},{0,-1},{-1,0}};
     for (int i = 0; i < 8; ++i)
     {
         for (int j = 0; j < 8; ++j)
         {
-            SDL_Rect rect = SDL_Rect {(int)(sw * i), (int)(sh * j), (int)sw, (int)sh};
-            switch(_game->_board[i][j])
+            Position pos{i, j};
+            if (_board[i][j] != _turnOrder)
+                continue;
+            for (auto direction : directions)
             {
-                case SquareState::BLACK_PAWN:
-                    SDL_RenderCopy(_renderer, _black, nullptr, &rect);
-                    break;
-                case SquareState::WHITE_PAWN:
-                    SDL_RenderCopy(_renderer, _white, nullptr, &rect);
-                    break;
+                auto dest = pos + direction;
+                if (dest.valid() && at(dest) == SquareState::EMPTY)
+                    moves.push_back({pos, dest});
             }
         }
     }
-    if (_game->_drawSelection)
-    {
-        SDL_Rect rect = {(int)(_game->_selectedField.x * sw), (int)(_game->_selectedField.y * sh), (int)sw, (int)sh};
-        SDL_RenderCopy(_renderer, _active, nullptr, &rect);
-    }
-    if (_game->_dragged)
+    return moves;
+}
+
+void BoardGame::computeTracking(uint64_t &hash, uint64_t (&pawns)[2], int (&distance)[2]) const
+{
+    hash = _turnOrder == SquareState::BLACK_PAWN ? ZOBRIST.blackTurn : 0;
+    pawns[0] = pawns[1] = 0;
+    distance[0] = distance[1] = 0;
+    for (int i = 0; i < 8; ++i)
     {
-        SDL_Rect rect = {(int)(_game->_selectedField.x * sw), (int)(_game->_selectedField.y * sh), (int)sw, (int)sh};
-        if (_game->_turnOrder == SquareState::WHITE_PAWN)
-        {
-            SDL_SetTextureAlphaMod(_white, 100);
-            SDL_RenderCopy(_renderer, _white, nullptr, &rect);
-            SDL_SetTextureAlphaMod(_white, 255);
-        }
-        else
+        for (int j = 0; j < 8; ++j)
         {
-            SDL_SetTextureAlphaMod(_black, 100);
-            SDL_RenderCopy(_renderer, _black, nullptr, &rect);
-            SDL_SetTextureAlphaMod(_black, 255);
+            auto pawn = _board[i][j];
+            if (pawn == SquareState::EMPTY)
+                continue;
+            hash ^= pawnKey(pawn, {i, j});
+            pawns[pawn == SquareState::BLACK_PAWN] |= squareBit({i, j});
+            distance[pawn == SquareState::BLACK_PAWN] += goalDistance(pawn, {i, j});
         }
     }
-    // Update screen
-    SDL_RenderPresent(_renderer);
 }
 
-SDL_Texture *BoardRenderer::loadTexture(std::string path)
+void BoardGame::resetTracking()
 {
-    //The final texture
-    SDL_Texture* newTexture = nullptr;
+    computeTracking(_hash, _pawns, _distance);
+    _bestDistance[0] = _distance[0];
+    _bestDistance[1] = _distance[1];
+    _noProgress = 0;
+    _result = GameResult::IN_PROGRESS;
+    _lastResult = GameResult::IN_PROGRESS;
+}
 
-    //Load image at specified path
-    SDL_Surface* loadedSurface = IMG_Load(path.c_str());
-    if(loadedSurface == nullptr)
+bool BoardGame::consistent() const
+{
+    if (_turnOrder == SquareState::EMPTY)
+        return false;
+    int pawns[3] = {0, 0, 0};
+    for (int i = 0; i < 8; ++i)
     {
-        printf("Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+        for (int j = 0; j < 8; ++j)
+            ++pawns[(int)_board[i][j]];
     }
-    else
+    if (pawns[(int)SquareState::WHITE_PAWN] != 9 || pawns[(int)SquareState::BLACK_PAWN] != 9)
+        return false;
+    uint64_t hash, pawnBits[2];
+    int distance[2];
+    computeTracking(hash, pawnBits, distance);
+    return hash == _hash && pawnBits[0] == _pawns[0] && pawnBits[1] == _pawns[1]
+        && distance[0] == _distance[0] && distance[1] == _distance[1]
+        && _bestDistance[0] <= _distance[0] && _bestDistance[1] <= _distance[1]
+        && _historyLength <= _history.size();
+}
+
+bool BoardGame::isGameOverWhite() const
+{
+    for (int i = 0; i < 3; ++i)
     {
-        //Create texture from surface pixels
-        newTexture = SDL_CreateTextureFromSurface(_renderer, loadedSurface);
-        if(newTexture == nullptr)
+        for (int j = 0; j < 3; ++j)
         {
-            printf("Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+            if (_board[i][j] != SquareState::WHITE_PAWN)
+                return false;
         }
-
-        //Get rid of old loaded surface
-        SDL_FreeSurface(loadedSurface);
     }
-
-    return newTexture;
+    return true;
 }
 
-Position BoardRenderer::squareAt(const int &x, const int &y) const
+bool BoardGame::isGameOverBlack() const
 {
-    int w, h;
-    SDL_GetRendererOutputSize(_renderer, &w, &h);
-    // float square sizes to avoid multiplication error
-    double sw = w * 0.125, sh = h * 0.125;
-    return {(int)(x / sw), (int)(y / sh)};
+    for (int i = 5; i < 8; ++i)
+    {
+        for (int j = 5; j < 8; ++j)
+        {
+            if (_board[i][j] != SquareState::BLACK_PAWN)
+                return false;
+        }
+    }
+    return true;
+}
+
+void BoardGame::resetGame() {
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            if (i < 3 && j < 3)
+                _board[i][j] = SquareState::BLACK_PAWN;
+            else if (i > 4 && j > 4)
+                _board[i][j] = SquareState::WHITE_PAWN;
+            else
+                _board[i][j] = SquareState::EMPTY;
+        }
+    }
+    _turnOrder = SquareState::WHITE_PAWN;
+    ++_revision;
+    _draggedField = {-1, -1};
+    _drawSelection = false;
+    _dragged = false;
+    _history.clear();
+    _historyLength = 0;
+    resetTracking();
 }
@@ -5,11 +5,14 @@
 #ifndef SDLGAMETEST_BOARDGAME_H
 #define SDLGAMETEST_BOARDGAME_H
 
-#include <SDL.h>
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 //! Possible states of a board square
-enum class SquareState
+enum class SquareState : uint8_t
 {
     EMPTY, //! No pawn
     WHITE_PAWN, //! White pawn
@@ -38,6 +41,36 @@ struct Position
 
 using Move = std::pair<Position, Position>;
 
+//! Outcome of a game
+enum class GameResult : uint8_t
+{
+    IN_PROGRESS, //! Game is not finished
+    WHITE_WON, //! White pawns reached black starting area
+    BLACK_WON, //! Black pawns reached white starting area
+    DRAW_REPETITION, //! Same position occurred for the third time
+    DRAW_NO_PROGRESS, //! Neither player got closer to the goal for too long
+    DRAW_NO_MOVES //! Player taking action has no legal moves
+};
+
+//! Complete copy of the game state: board, turn, UI state and draw detection counters.
+//! Trivially copyable, so saving and restoring it is a plain memcpy
+struct GameSnapshot
+{
+    SquareState board[8][8];
+    Position selectedField;
+    Position draggedField;
+    bool drawSelection;
+    bool dragged;
+    SquareState turnOrder;
+    GameResult result;
+    uint64_t hash;
+    uint64_t pawns[2];
+    int distance[2];
+    int bestDistance[2];
+    int noProgress;
+};
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "GameSnapshot must stay trivially copyable");
+
 //! Board game state
 class BoardGame
 {
@@ -56,11 +89,59 @@ class BoardGame
     //! Player currently taking action
     SquareState _turnOrder = SquareState::WHITE_PAWN;
 
+    //! Undo history entry: move, hash and draw detection counters from before it
+    struct MoveRecord
+    {
+        Move move;
+        uint64_t hash;
+        int noProgress;
+        int bestDistance[2];
+    };
+    //! Moves made since the last reset; entries past _historyLength can be redone
+    std::vector<MoveRecord> _history;
+    //! Number of moves currently applied to the board
+    size_t _historyLength = 0;
+
+    //! Zobrist hash of the board and turn, updated incrementally
+    uint64_t _hash = 0;
+    //! Bitboards of white [0] and black [1] pawns, bit x * 8 + y
+    uint64_t _pawns[2] = {0, 0};
+    //! Total steps white [0] and black [1] pawns need to reach the goal
+    int _distance[2] = {0, 0};
+    //! Smallest _distance reached since the last reset
+    int _bestDistance[2] = {0, 0};
+    //! Moves since either player reached a new smallest distance
+    int _noProgress = 0;
+    //! Result of the current position, set when make() finishes the game
+    GameResult _result = GameResult::IN_PROGRESS;
+    //! Result of the last game finished and reset by makeMove()
+    GameResult _lastResult = GameResult::IN_PROGRESS;
+    //! Incremented on every board change
+    uint64_t _revision = 0;
+
     //! Win condition for white pawns
     bool isGameOverWhite() const;
     //! Win condition for black pawns
     bool isGameOverBlack() const;
+    //! Checks if player taking action can move any pawn, bitboard version of !legalMoves().empty()
+    bool hasLegalMoves() const;
+    //! Occurrences of current position since the last progress, including this one
+    int repetitions() const;
+    //! Moves pawn and passes the turn, updates hash and distances, no validation
+    void applyMove(const Move &move);
+    //! Updates progress counters after a move by the player who just made it
+    void updateProgress(SquareState mover);
+    //! Result of the position reached by a move of mover
+    GameResult evaluate(SquareState mover) const;
+    //! Recomputes hash, bitboards and distances from scratch and clears draw detection history
+    void resetTracking();
+    //! Hash, bitboards and goal distances computed from scratch, reference for incremental updates
+    void computeTracking(uint64_t &hash, uint64_t (&pawns)[2], int (&distance)[2]) const;
 public:
+    //! Same position occurring this many times is a draw
+    static constexpr int REPETITION_LIMIT = 3;
+    //! Moves without progress of either player before the game is a draw
+    static constexpr int NO_PROGRESS_LIMIT = 100;
 
     BoardGame();
     //! Game reset
@@ -71,41 +152,58 @@ public:
     Position selectedField() const  { return _selectedField; }
     //! Drag&drop position getter
     Position draggedField() const { return _draggedField; }
+    //! Player currently taking action
+    SquareState turnOrder() const { return _turnOrder; }
+    //! Result of the current position, IN_PROGRESS unless make() or redo() finished the game
+    GameResult result() const { return _result; }
+    //! Result of the last game finished by makeMove(), IN_PROGRESS once the next game has started.
+    //! Finished games are reset right away, so check it after makeMove()
+    GameResult lastResult() const { return _lastResult; }
+    //! Position hash, equal for equal boards with the same player taking action
+    uint64_t hash() const { return _hash; }
+    //! Board change counter, lets renderers skip boards that didn't change
+    uint64_t revision() const { return _revision; }
+    //! Checks game state invariants: 9 pawns of each color, valid player taking action,
+    //! hash, bitboards and goal distances equal to values recomputed from scratch.
+    //! Too slow for every move, SDLGameFuzz checks it after every operation
+    bool consistent() const;
     //! Selected square movement (for keyboard/gamepad)
     bool moveSelected(const Position &diff);
     //! Selected square movement (for mouse controls and drag&drop)
     void setHovered(const Position &diff);
     //! Mouse drag initialization
     bool setDragged(const Position &pos);
-    //!
+    //! Makes a move for the player taking action, returns false for illegal moves.
+    //! A move that finishes the game resets it, the outcome is reported by lastResult()
     bool makeMove(const Move &move);
-};
-
-
-//! Board game renderer
-class BoardRenderer
-{
-    //! Game state
-    BoardGame *_game; // initialized in constructor
-    //! SDL renderer
-    SDL_Renderer *_renderer; // initialized in constructor
-    //! Board texture
-    SDL_Texture* _boardTexture = nullptr;
-    //! White pawn texture
-    SDL_Texture* _white = nullptr;
-    //! Black pawn texture
-    SDL_Texture* _black = nullptr;
-    //! Active square border texture
-    SDL_Texture* _active = nullptr;
-
-    //! Load texture for hardware-accelerated rendering
-    SDL_Texture* loadTexture( std::string path );
-public:
-    BoardRenderer(BoardGame *game, SDL_Renderer *renderer);
-    //! Game graphics rendering
-    void render();
-    //! Position of board square represented by window pixel {x, y}
-    Position squareAt(const int &x, const int &y) const;
+    //! Makes a move without resetting finished games, for search make/unmake.
+    //! The final position keeps its result() and can be taken back with undo().
+    //! Returns false for illegal moves and when the game is already finished
+    bool make(const Move &move);
+    //! Takes back the last move, returns false if there is nothing to undo
+    bool undo();
+    //! Makes the last undone move again, returns false if there is nothing to redo
+    bool redo();
+    //! Undo availability
+    bool canUndo() const { return _historyLength > 0; }
+    //! Redo availability
+    bool canRedo() const { return _historyLength < _history.size(); }
+    //! Copy of the current game state
+    GameSnapshot snapshot() const;
+    //! Replaces the game state with a snapshot in constant time.
+    //! Undo history is dropped, so repetitions of positions before the snapshot are not detected
+    void restore(const GameSnapshot &snapshot);
+    //! Replaces the board and player taking action, recomputes draw detection state.
+    //! Undo history is dropped
+    void setPosition(const SquareState (&board)[8][8], SquareState turnOrder);
+    //! Replaces the position with game rotated by 180 degrees and pawn colors swapped,
+    //! so that the other color takes action. Undo history is dropped
+    void setMirrored(const BoardGame &game);
+    //! Square at pos on the board rotated by 180 degrees
+    static Position mirrored(const Position &pos) { return {7 - pos.x, 7 - pos.y}; }
+    //! Moves available to the player taking action, found by scanning every square.
+    //! Doesn't check if the game is finished
+    std::vector<Move> legalMoves() const;
 };
 
 #endif //SDLGAMETEST_BOARDGAME_H
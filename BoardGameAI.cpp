@@ -3,13 +3,24 @@
 //
 
 #include "BoardGameAI.h"
+#include "BoardGameAITables.h"
 
 #include <algorithm>
+#include <iterator>
 
-BoardGameAI::BoardGameAI(BoardGame *game) :
+BoardGameAIParams BoardGameAIParams::defaults()
+{
+    BoardGameAIParams params;
+    std::copy(std::begin(BoardGameAITables::DEST_PRIORITY), std::end(BoardGameAITables::DEST_PRIORITY), params.destPriority.begin());
+    std::copy(std::begin(BoardGameAITables::LEAVE_PRIORITY), std::end(BoardGameAITables::LEAVE_PRIORITY), params.leavePriority.begin());
+    std::copy(std::begin(BoardGameAITables::STEP_PRIORITY), std::end(BoardGameAITables::STEP_PRIORITY), params.stepPriority.begin());
+    std::copy(std::begin(BoardGameAITables::LEAVE_STEPS), std::end(BoardGameAITables::LEAVE_STEPS), params.leaveSteps.begin());
+    return params;
+}
+
+BoardGameAI::BoardGameAI(BoardGame *game, const BoardGameAIParams &params) :
     _game(game),
-    _destPriority{{7,7},{6,7},{7,6},{5,7},{6,6},{7,5},{5,6},{6,5},{5,5}},
-    _leavePriority{{0,0},{1,0},{0,1},{2,0},{1,1},{0,2},{2,1},{1,2},{2,2}}
+    _params(params)
 {
 
 }
@@ -70,8 +81,8 @@ std::pair<Move, std::set<Position> > BoardGameAI::search(const Position &src, Se
                 if(mode == SearchMode::NEXT_MOVE)
                 {
                     // Any black pawn not already in place fits
-                    auto fromPriority = std::find(_destPriority.begin(), _destPriority.end(), neighbor);
-                    auto toPriority = std::find(_destPriority.begin(), _destPriority.end(), src);
+                    auto fromPriority = std::find(_params.destPriority.begin(), _params.destPriority.end(), neighbor);
+                    auto toPriority = std::find(_params.destPriority.begin(), _params.destPriority.end(), src);
                     // If pawn is not already in place (fromPriority == end) or destination is first in priority list
                     if (toPriority < fromPriority)
                     {
@@ -84,20 +95,20 @@ std::pair<Move, std::set<Position> > BoardGameAI::search(const Position &src, Se
                 }
                 else if (mode == SearchMode::PAWN_CAN_MOVE || mode == SearchMode::IGNORE_WHITE)
                 {
-                    // Check if pawn can step right or down
-                    auto down = neighbor + directions[0];
-                    if (down.valid() && _game->at(down) == SquareState::EMPTY)
-                        return {{neighbor, down}, accessible};
-                    auto right = neighbor + directions[1];
-                    if (right.valid() && _game->at(right) == SquareState::EMPTY)
-                        return {{neighbor, right}, accessible};
+                    // Check if pawn can step in a preferred direction (down or right by default)
+                    for (int k = 0; k < 2; ++k)
+                    {
+                        auto step = neighbor + _params.stepPriority[k];
+                        if (step.valid() && _game->at(step) == SquareState::EMPTY)
+                            return {{neighbor, step}, accessible};
+                    }
                     // If pawn can step at all, it is reserved and the search continues
-                    auto up = neighbor + directions[2];
-                    if (up.valid() && _game->at(up) == SquareState::EMPTY)
-                        reserve = {neighbor, up};
-                    auto left = neighbor + directions[3];
-                    if (left.valid() && _game->at(left) == SquareState::EMPTY)
-                        reserve = {neighbor, left};
+                    for (int k = 2; k < 4; ++k)
+                    {
+                        auto step = neighbor + _params.stepPriority[k];
+                        if (step.valid() && _game->at(step) == SquareState::EMPTY)
+                            reserve = {neighbor, step};
+                    }
                     checked.insert(neighbor);
                     next.push(neighbor);
                 }
@@ -117,16 +128,15 @@ std::pair<Move, std::set<Position> > BoardGameAI::search(const Position &src, Se
 
 Move BoardGameAI::getNextMove() {
     // Try to leave start area first
-    for (auto pos : _leavePriority)
+    for (auto pos : _params.leavePriority)
     {
         if(_game->at(pos) == SquareState::BLACK_PAWN)
         {
-            auto right = pos + Position{1, 0};
-            if (right.valid() && _game->at(right) == SquareState::EMPTY)
-                return {pos, right};
-            auto down = pos + Position{0, 1};
-            if (down.valid() && _game->at(down) == SquareState::EMPTY) {
-                return {pos, down};
+            for (auto step : _params.leaveSteps)
+            {
+                auto dest = pos + step;
+                if (dest.valid() && _game->at(dest) == SquareState::EMPTY)
+                    return {pos, dest};
             }
         }
     }
@@ -137,7 +147,7 @@ Move BoardGameAI::getNextMove() {
     // Find best move in order of target priority
     std::set<Position> accessible = breadthFirstSearch({-1, -1}, SearchMode::ACCESSIBLE).second;
     Position prioritized = {-1, -1};
-    for (auto pos : _destPriority)
+    for (auto pos : _params.destPriority)
     {
         if (accessible.count(pos))
         {
@@ -169,19 +179,12 @@ Move BoardGameAI::getNextMove() {
                 Position pos{i, j};
                 if (_game->at(pos) == SquareState::BLACK_PAWN)
                 {
-                    auto down = pos + Position{0, 1};
-                    if (down.valid() && _game->at(down) == SquareState::EMPTY)
-                        return {pos, down};
-                    auto right = pos + Position{1, 0};
-                    if (right.valid() && _game->at(right) == SquareState::EMPTY)
-                        return {pos, right};
-                    // If pawn can step at all, it is reserved and the search continues
-                    auto up = pos + Position{0, -1};
-                    if (up.valid() && _game->at(up) == SquareState::EMPTY)
-                        return {pos, up};
-                    auto left = pos + Position{-1, 0};
-                    if (left.valid() && _game->at(left) == SquareState::EMPTY)
-                        return {pos, left};
+                    for (auto step : _params.stepPriority)
+                    {
+                        auto dest = pos + step;
+                        if (dest.valid() && _game->at(dest) == SquareState::EMPTY)
+                            return {pos, dest};
+                    }
                 }
             }
         }
@@ -192,5 +195,8 @@ Move BoardGameAI::getNextMove() {
 
 bool BoardGameAI::isLegal(const Move &move) const
 {
+    // Search returns {-1, -1} squares when it finds nothing, they must not reach the board
+    if (!move.first.valid() || !move.second.valid())
+        return false;
     return _game->at(move.first) == SquareState::BLACK_PAWN && _game->at(move.second) == SquareState::EMPTY;
 }
@@ -7,17 +7,32 @@
 
 #include "BoardGame.h"
 
+#include <array>
 #include <set>
 #include <vector>
 #include <queue>
 
+//! Tunable AI move orderings, defaults come from BoardGameAITables.h
+struct BoardGameAIParams
+{
+    //! List of destination squares in order of priority
+    std::array<Position, 9> destPriority;
+    //! List of start squares in order of leave priority
+    std::array<Position, 9> leavePriority;
+    //! Pawn steps in order of preference, the last two are only used to unblock the game
+    std::array<Position, 4> stepPriority;
+    //! Steps used to leave start area in order of preference
+    std::array<Position, 2> leaveSteps;
+
+    //! Orderings from BoardGameAITables.h
+    static BoardGameAIParams defaults();
+};
+
 class BoardGameAI {
     //! Game state
     BoardGame *_game;
-    //! List of destination squares in order of priority
-    std::vector<Position> _destPriority;
-    //! List of start squares in order of leave priority
-    std::vector<Position> _leavePriority;
+    //! Move orderings
+    BoardGameAIParams _params;
 
     //! Board search configurations
     enum class SearchMode
@@ -41,10 +56,10 @@ class BoardGameAI {
 
     //! Move validation
     bool isLegal(const Move &move) const;
+public:
+    explicit BoardGameAI(BoardGame *game, const BoardGameAIParams &params = BoardGameAIParams::defaults());
     //! Search for the best available move
     Move getNextMove();
-public:
-    explicit BoardGameAI(BoardGame *game);
     //! AI action
     bool act() { return _game->makeMove(getNextMove()); }
 };
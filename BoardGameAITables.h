@@ -0,0 +1,23 @@
+//
+// Default AI move orderings.
+// SDLGameTune writes tuned tables in the same format, replace this file with its output to use them.
+//
+
+#ifndef SDLGAMETEST_BOARDGAMEAITABLES_H
+#define SDLGAMETEST_BOARDGAMEAITABLES_H
+
+#include "BoardGame.h"
+
+namespace BoardGameAITables
+{
+    //! Destination squares in order of priority
+    constexpr Position DEST_PRIORITY[9] = {{7,7},{6,7},{7,6},{5,7},{6,6},{7,5},{5,6},{6,5},{5,5}};
+    //! Start squares in order of leave priority
+    constexpr Position LEAVE_PRIORITY[9] = {{0,0},{1,0},{0,1},{2,0},{1,1},{0,2},{2,1},{1,2},{2,2}};
+    //! Pawn steps in order of preference, the last two are only used to unblock the game
+    constexpr Position STEP_PRIORITY[4] = {{0,1},{1,0},{0,-1},{-1,0}};
+    //! Steps used to leave start area in order of preference
+    constexpr Position LEAVE_STEPS[2] = {{1,0},{0,1}};
+}
+
+#endif //SDLGAMETEST_BOARDGAMEAITABLES_H
@@ -0,0 +1,424 @@
+//
+// Created by doublekir on 5/4/23.
+//
+
+#include "BoardRenderer.h"
+#include <SDL_image.h>
+
+#include <algorithm>
+#include <cstdio>
+
+BoardRenderer::BoardRenderer(BoardGame *game, SDL_Renderer *renderer) :
+    _game(game),
+    _renderer(renderer)
+{
+    loadTextures();
+    SDL_Window *window = SDL_RenderGetWindow(_renderer);
+    if (window)
+        _title = SDL_GetWindowTitle(window);
+    resize();
+}
+
+BoardRenderer::~BoardRenderer()
+{
+    releaseTextures();
+}
+
+void BoardRenderer::loadTextures()
+{
+    _boardTexture = loadTexture("chessboard.png");
+    _black = loadTexture("blackpawn.png");
+    _white = loadTexture("whitepawn.png");
+    _active = loadTexture("border.png");
+}
+
+void BoardRenderer::releaseTextures()
+{
+    releaseScaled();
+    for (auto texture : {&_atlas, &_gridTexture, &_boardTexture, &_black, &_white, &_active})
+    {
+        if (*texture)
+            SDL_DestroyTexture(*texture);
+        *texture = nullptr;
+    }
+}
+
+void BoardRenderer::reload()
+{
+    // Device reset loses every texture, including the sources pre-scaled ones are made from
+    releaseTextures();
+    loadTextures();
+    resize();
+}
+
+void BoardRenderer::releaseScaled()
+{
+    for (auto texture : {&_boardScaled, &_whiteScaled, &_blackScaled, &_activeScaled})
+    {
+        if (*texture)
+            SDL_DestroyTexture(*texture);
+        *texture = nullptr;
+    }
+}
+
+void BoardRenderer::resize()
+{
+    SDL_GetRendererOutputSize(_renderer, &_outputWidth, &_outputHeight);
+    _squareWidth = _outputWidth * 0.125;
+    _squareHeight = _outputHeight * 0.125;
+    // Mouse events use window coordinates, which differ from output pixels on HiDPI displays
+    int windowWidth = _outputWidth, windowHeight = _outputHeight;
+    SDL_Window *window = SDL_RenderGetWindow(_renderer);
+    if (window)
+        SDL_GetWindowSize(window, &windowWidth, &windowHeight);
+    _scaleX = windowWidth > 0 ? (double)_outputWidth / windowWidth : 1.0;
+    _scaleY = windowHeight > 0 ? (double)_outputHeight / windowHeight : 1.0;
+
+    releaseScaled();
+    // Grid board size depends on output size
+    _gridSize = 0;
+    if (!SDL_RenderTargetSupported(_renderer))
+        return;
+    _boardScaled = scaleTexture(_boardTexture, _outputWidth, _outputHeight);
+    _whiteScaled = scaleTexture(_white, (int)_squareWidth, (int)_squareHeight);
+    _blackScaled = scaleTexture(_black, (int)_squareWidth, (int)_squareHeight);
+    _activeScaled = scaleTexture(_active, (int)_squareWidth, (int)_squareHeight);
+}
+
+SDL_Texture *BoardRenderer::scaleTexture(SDL_Texture *source, int w, int h)
+{
+    if (source == nullptr || w <= 0 || h <= 0)
+        return nullptr;
+    int sourceWidth, sourceHeight;
+    SDL_QueryTexture(source, nullptr, nullptr, &sourceWidth, &sourceHeight);
+
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(_renderer, &r, &g, &b, &a);
+    SDL_Texture *previous = SDL_GetRenderTarget(_renderer);
+    SDL_Texture *current = source;
+    // Linear filtering only looks at 4 pixels, so large textures are halved until
+    // they are at most twice the target size, like picking a mipmap level
+    while (current)
+    {
+        int stepWidth = std::max(w, sourceWidth / 2), stepHeight = std::max(h, sourceHeight / 2);
+        if (sourceWidth <= w * 2 && sourceHeight <= h * 2)
+        {
+            stepWidth = w;
+            stepHeight = h;
+        }
+        SDL_Texture *step = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, stepWidth, stepHeight);
+        if (step != nullptr)
+        {
+            SDL_SetTextureBlendMode(step, SDL_BLENDMODE_BLEND);
+            SDL_SetRenderTarget(_renderer, step);
+            SDL_SetRenderDrawColor(_renderer, 0, 0, 0, 0);
+            SDL_RenderClear(_renderer);
+            // Copy alpha as is instead of blending it with transparent target
+            SDL_SetTextureBlendMode(current, SDL_BLENDMODE_NONE);
+            SDL_RenderCopy(_renderer, current, nullptr, nullptr);
+            SDL_SetTextureBlendMode(current, SDL_BLENDMODE_BLEND);
+        }
+        if (current != source)
+            SDL_DestroyTexture(current);
+        current = step;
+        sourceWidth = stepWidth;
+        sourceHeight = stepHeight;
+        if (stepWidth == w && stepHeight == h)
+            break;
+    }
+    SDL_SetRenderTarget(_renderer, previous);
+    SDL_SetRenderDrawColor(_renderer, r, g, b, a);
+    if (current == nullptr)
+        printf("Unable to scale texture! SDL Error: %s\n", SDL_GetError());
+    return current;
+}
+
+void BoardRenderer::updateTitle()
+{
+    if (_game->_lastResult == _shownResult)
+        return;
+    _shownResult = _game->_lastResult;
+    SDL_Window *window = SDL_RenderGetWindow(_renderer);
+    if (!window)
+        return;
+    std::string title = _title;
+    switch (_shownResult)
+    {
+        case GameResult::WHITE_WON:
+            title += " - White wins";
+            break;
+        case GameResult::BLACK_WON:
+            title += " - Black wins";
+            break;
+        case GameResult::DRAW_REPETITION:
+            title += " - Draw by repetition";
+            break;
+        case GameResult::DRAW_NO_PROGRESS:
+            title += " - Draw, no progress";
+            break;
+        case GameResult::DRAW_NO_MOVES:
+            title += " - Draw, no moves left";
+            break;
+        case GameResult::IN_PROGRESS:
+            break;
+    }
+    SDL_SetWindowTitle(window, title.c_str());
+}
+
+void BoardRenderer::render()
+{
+    updateTitle();
+    SDL_RenderClear(_renderer);
+    auto board = _boardScaled ? _boardScaled : _boardTexture;
+    auto white = _whiteScaled ? _whiteScaled : _white;
+    auto black = _blackScaled ? _blackScaled : _black;
+    auto active = _activeScaled ? _activeScaled : _active;
+    // Render board texture to screen
+    SDL_RenderCopy(_renderer, board, nullptr, nullptr);
+    double sw = _squareWidth, sh = _squareHeight;
+
+    // Render pieces
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            SDL_Rect rect = SDL_Rect {(int)(sw * i), (int)(sh * j), (int)sw, (int)sh};
+            switch(_game->_board[i][j])
+            {
+                case SquareState::BLACK_PAWN:
+                    SDL_RenderCopy(_renderer, black, nullptr, &rect);
+                    break;
+                case SquareState::WHITE_PAWN:
+                    SDL_RenderCopy(_renderer, white, nullptr, &rect);
+                    break;
+                case SquareState::EMPTY:
+                    break;
+            }
+        }
+    }
+    if (_game->_drawSelection)
+    {
+        SDL_Rect rect = {(int)(_game->_selectedField.x * sw), (int)(_game->_selectedField.y * sh), (int)sw, (int)sh};
+        SDL_RenderCopy(_renderer, active, nullptr, &rect);
+    }
+    if (_game->_dragged)
+    {
+        SDL_Rect rect = {(int)(_game->_selectedField.x * sw), (int)(_game->_selectedField.y * sh), (int)sw, (int)sh};
+        auto pawn = _game->_turnOrder == SquareState::WHITE_PAWN ? white : black;
+        SDL_SetTextureAlphaMod(pawn, 100);
+        SDL_RenderCopy(_renderer, pawn, nullptr, &rect);
+        SDL_SetTextureAlphaMod(pawn, 255);
+    }
+    // Update screen
+    SDL_RenderPresent(_renderer);
+}
+
+void BoardRenderer::layoutGrid(size_t size)
+{
+    _gridSize = size;
+    _gridColumns = 1;
+    while ((size_t)_gridColumns * _gridColumns < size)
+        ++_gridColumns;
+    int rows = (int)((size + _gridColumns - 1) / _gridColumns);
+    _gridBoard = std::max(8, std::min(_outputWidth / _gridColumns, _outputHeight / std::max(rows, 1))) / 8 * 8;
+    int pawn = _gridBoard / 8;
+
+    for (auto texture : {&_atlas, &_gridTexture})
+    {
+        if (*texture)
+            SDL_DestroyTexture(*texture);
+        *texture = nullptr;
+    }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    bool geometry = SDL_RenderTargetSupported(_renderer);
+#else
+    // Atlas quads need SDL_RenderGeometry, older SDL copies source textures every frame
+    bool geometry = false;
+#endif
+    if (geometry)
+    {
+        SDL_Texture *board = scaleTexture(_boardTexture, _gridBoard, _gridBoard);
+        SDL_Texture *white = scaleTexture(_white, pawn, pawn);
+        SDL_Texture *black = scaleTexture(_black, pawn, pawn);
+        _atlas = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, _gridBoard + pawn, _gridBoard);
+        if (_atlas && board && white && black)
+        {
+            Uint8 r, g, b, a;
+            SDL_GetRenderDrawColor(_renderer, &r, &g, &b, &a);
+            SDL_Texture *previous = SDL_GetRenderTarget(_renderer);
+            SDL_SetTextureBlendMode(_atlas, SDL_BLENDMODE_BLEND);
+            SDL_SetRenderTarget(_renderer, _atlas);
+            SDL_SetRenderDrawColor(_renderer, 0, 0, 0, 0);
+            SDL_RenderClear(_renderer);
+            SDL_Rect rects[3] = {{0, 0, _gridBoard, _gridBoard}, {_gridBoard, 0, pawn, pawn}, {_gridBoard, pawn, pawn, pawn}};
+            SDL_Texture *parts[3] = {board, white, black};
+            for (int i = 0; i < 3; ++i)
+            {
+                SDL_SetTextureBlendMode(parts[i], SDL_BLENDMODE_NONE);
+                SDL_RenderCopy(_renderer, parts[i], nullptr, &rects[i]);
+            }
+            SDL_SetRenderTarget(_renderer, previous);
+            SDL_SetRenderDrawColor(_renderer, r, g, b, a);
+        }
+        else if (_atlas)
+        {
+            SDL_DestroyTexture(_atlas);
+            _atlas = nullptr;
+        }
+        for (auto texture : {board, white, black})
+        {
+            if (texture)
+                SDL_DestroyTexture(texture);
+        }
+    }
+    if (_atlas)
+    {
+        _gridTexture = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, _outputWidth, _outputHeight);
+        if (_gridTexture)
+        {
+            // Cleared once, space not covered by boards is never drawn again
+            SDL_Texture *previous = SDL_GetRenderTarget(_renderer);
+            SDL_SetTextureBlendMode(_gridTexture, SDL_BLENDMODE_NONE);
+            SDL_SetRenderTarget(_renderer, _gridTexture);
+            SDL_RenderClear(_renderer);
+            SDL_SetRenderTarget(_renderer, previous);
+        }
+    }
+
+    _gridBuilt.assign(size, {nullptr, 0});
+    _gridVertices.assign(size * GRID_QUADS * 4, GridVertex{{0, 0}, {0xFF, 0xFF, 0xFF, 0xFF}, {0, 0}});
+    _gridIndices.resize(size * GRID_QUADS * 6);
+    for (size_t quad = 0; quad < size * GRID_QUADS; ++quad)
+    {
+        // Vertices go top left, top right, bottom left, bottom right
+        int base = (int)quad * 4;
+        int triangles[6] = {base, base + 1, base + 2, base + 2, base + 1, base + 3};
+        std::copy(triangles, triangles + 6, _gridIndices.begin() + quad * 6);
+    }
+}
+
+void BoardRenderer::buildGridBoard(size_t index, const BoardGame &game)
+{
+    float boardX = (float)(index % _gridColumns * _gridBoard), boardY = (float)(index / _gridColumns * _gridBoard);
+    // Board size is a multiple of 8, so squares have the same whole pixel size as atlas pawns
+    int pawn = _gridBoard / 8;
+    float atlasWidth = (float)(_gridBoard + pawn), atlasHeight = (float)_gridBoard;
+    GridVertex *vertex = &_gridVertices[index * GRID_QUADS * 4];
+    auto quad = [&](float x, float y, float size, int u, int v, int uvSize) {
+        float u0 = u / atlasWidth, v0 = v / atlasHeight, u1 = (u + uvSize) / atlasWidth, v1 = (v + uvSize) / atlasHeight;
+        vertex[0].position = {x, y};
+        vertex[0].tex_coord = {u0, v0};
+        vertex[1].position = {x + size, y};
+        vertex[1].tex_coord = {u1, v0};
+        vertex[2].position = {x, y + size};
+        vertex[2].tex_coord = {u0, v1};
+        vertex[3].position = {x + size, y + size};
+        vertex[3].tex_coord = {u1, v1};
+        vertex += 4;
+    };
+
+    quad(boardX, boardY, (float)_gridBoard, 0, 0, _gridBoard);
+    int quads = 1;
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            auto state = game.at({i, j});
+            if (state == SquareState::EMPTY || quads == GRID_QUADS)
+                continue;
+            quad(boardX + (float)(pawn * i), boardY + (float)(pawn * j), (float)pawn, _gridBoard, state == SquareState::WHITE_PAWN ? 0 : pawn, pawn);
+            ++quads;
+        }
+    }
+    // Unused quads are collapsed to nothing
+    for (; quads < GRID_QUADS; ++quads)
+        quad(0, 0, 0, 0, 0, 0);
+}
+
+bool BoardRenderer::renderGrid(const std::vector<const BoardGame*> &games, bool force)
+{
+    if (games.size() != _gridSize)
+    {
+        layoutGrid(games.size());
+        force = true;
+    }
+    _gridChanged.clear();
+    for (size_t i = 0; i < games.size(); ++i)
+    {
+        std::pair<const BoardGame*, uint64_t> built = {games[i], games[i]->revision()};
+        if (built == _gridBuilt[i])
+            continue;
+        _gridBuilt[i] = built;
+        buildGridBoard(i, *games[i]);
+        // Board quad goes first, so it covers the previous pawns
+        _gridChanged.insert(_gridChanged.end(), _gridIndices.begin() + i * GRID_QUADS * 6,
+                            _gridIndices.begin() + (i + 1) * GRID_QUADS * 6);
+    }
+    if (_gridChanged.empty() && !force)
+        return false;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if (_gridTexture)
+    {
+        if (!_gridChanged.empty())
+        {
+            SDL_SetRenderTarget(_renderer, _gridTexture);
+            SDL_RenderGeometry(_renderer, _atlas, _gridVertices.data(), (int)_gridVertices.size(),
+                               _gridChanged.data(), (int)_gridChanged.size());
+            SDL_SetRenderTarget(_renderer, nullptr);
+        }
+        SDL_RenderCopy(_renderer, _gridTexture, nullptr, nullptr);
+    }
+    else
+#endif
+    {
+        // No render targets, copy quads of all boards from source textures one by one
+        SDL_RenderClear(_renderer);
+        for (size_t quad = 0; quad < _gridVertices.size() / 4; ++quad)
+        {
+            const GridVertex *vertex = &_gridVertices[quad * 4];
+            SDL_Rect rect = {(int)vertex[0].position.x, (int)vertex[0].position.y,
+                             (int)(vertex[3].position.x - vertex[0].position.x), (int)(vertex[3].position.y - vertex[0].position.y)};
+            if (rect.w <= 0)
+                continue;
+            SDL_Texture *texture = _boardTexture;
+            if (quad % GRID_QUADS != 0)
+                texture = vertex[0].tex_coord.y == 0 ? _white : _black;
+            SDL_RenderCopy(_renderer, texture, nullptr, &rect);
+        }
+    }
+    SDL_RenderPresent(_renderer);
+    return true;
+}
+
+SDL_Texture *BoardRenderer::loadTexture(std::string path)
+{
+    //The final texture
+    SDL_Texture* newTexture = nullptr;
+
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load(path.c_str());
+    if(loadedSurface == nullptr)
+    {
+        printf("Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+    }
+    else
+    {
+        //Create texture from surface pixels
+        newTexture = SDL_CreateTextureFromSurface(_renderer, loadedSurface);
+        if(newTexture == nullptr)
+        {
+            printf("Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+        }
+
+        //Get rid of old loaded surface
+        SDL_FreeSurface(loadedSurface);
+    }
+
+    return newTexture;
+}
+
+Position BoardRenderer::squareAt(const int &x, const int &y) const
+{
+    return {(int)(x * _scaleX / _squareWidth), (int)(y * _scaleY / _squareHeight)};
+}
@@ -0,0 +1,116 @@
+//
+// Created by doublekir on 5/4/23.
+//
+
+#ifndef SDLGAMETEST_BOARDRENDERER_H
+#define SDLGAMETEST_BOARDRENDERER_H
+
+#include "BoardGame.h"
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+//! Board game renderer
+class BoardRenderer
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    typedef SDL_Vertex GridVertex;
+#else
+    //! SDL_Vertex layout for SDL before 2.0.18, which has no SDL_RenderGeometry
+    struct GridVertex { struct { float x, y; } position; SDL_Color color; struct { float x, y; } tex_coord; };
+#endif
+    //! Game state
+    BoardGame *_game; // initialized in constructor
+    //! SDL renderer
+    SDL_Renderer *_renderer; // initialized in constructor
+    //! Board texture
+    SDL_Texture* _boardTexture = nullptr;
+    //! White pawn texture
+    SDL_Texture* _white = nullptr;
+    //! Black pawn texture
+    SDL_Texture* _black = nullptr;
+    //! Active square border texture
+    SDL_Texture* _active = nullptr;
+    //! Textures above pre-scaled to current square size (board to output size),
+    //! so that every frame copies them 1:1 without filtering.
+    //! nullptr if render targets are not supported, source textures are drawn instead
+    SDL_Texture* _boardScaled = nullptr;
+    SDL_Texture* _whiteScaled = nullptr;
+    SDL_Texture* _blackScaled = nullptr;
+    SDL_Texture* _activeScaled = nullptr;
+    //! Renderer output size in pixels
+    int _outputWidth = 0, _outputHeight = 0;
+    //! Square size in output pixels, float to avoid multiplication error
+    double _squareWidth = 0, _squareHeight = 0;
+    //! Output pixels per window coordinate, above 1 on HiDPI displays
+    double _scaleX = 1, _scaleY = 1;
+    //! Spectator grid atlas: board scaled to grid board size, white and black pawns
+    //! scaled to its square size to the right of it, one above the other
+    SDL_Texture* _atlas = nullptr;
+    //! Output-sized grid of all boards kept between frames, only boards that changed are redrawn
+    //! into it. nullptr if render targets are not supported or SDL is older than 2.0.18,
+    //! the grid is redrawn every frame instead
+    SDL_Texture* _gridTexture = nullptr;
+    //! Number of boards current grid layout is computed for, 0 when layout has to be rebuilt
+    size_t _gridSize = 0;
+    //! Grid columns
+    int _gridColumns = 0;
+    //! Grid board size in output pixels, multiple of 8 so that pawns get whole pixels
+    int _gridBoard = 0;
+    //! Boards and revisions the grid vertices were built from
+    std::vector<std::pair<const BoardGame*, uint64_t> > _gridBuilt;
+    //! Board and pawn quads of all grid boards, GRID_QUADS * 4 vertices per board
+    std::vector<GridVertex> _gridVertices;
+    //! Two triangles per quad
+    std::vector<int> _gridIndices;
+    //! Indices of boards changed since the last frame, rebuilt every frame
+    std::vector<int> _gridChanged;
+    //! Window title before game results were added to it
+    std::string _title;
+    //! Game result currently shown in window title
+    GameResult _shownResult = GameResult::IN_PROGRESS;
+
+    //! Load texture for hardware-accelerated rendering
+    SDL_Texture* loadTexture( std::string path );
+    //! Loads source textures from image files
+    void loadTextures();
+    //! Destroys source, pre-scaled and atlas textures
+    void releaseTextures();
+    //! Shows result of the last finished game in window title
+    void updateTitle();
+    //! Copy of source texture with size w x h, halved step by step to avoid aliasing
+    SDL_Texture* scaleTexture(SDL_Texture* source, int w, int h);
+    //! Destroys pre-scaled textures
+    void releaseScaled();
+    //! Computes grid layout for given number of boards and builds atlas for it
+    void layoutGrid(size_t size);
+    //! Rebuilds vertices of grid board at index
+    void buildGridBoard(size_t index, const BoardGame &game);
+public:
+    //! Quads per grid board: the board and 18 pawns
+    static constexpr int GRID_QUADS = 19;
+
+    //! game may be nullptr if only renderGrid() is used
+    BoardRenderer(BoardGame *game, SDL_Renderer *renderer);
+    ~BoardRenderer();
+    BoardRenderer(const BoardRenderer &) = delete;
+    BoardRenderer &operator=(const BoardRenderer &) = delete;
+    //! Recomputes scale metrics and pre-scaled textures, call when window size changes
+    //! or render targets are reset
+    void resize();
+    //! Recreates all textures, call when the render device is reset and textures are lost
+    void reload();
+    //! Game graphics rendering
+    void render();
+    //! Renders games as a grid of small boards without selection, for spectating many games.
+    //! Boards that changed are redrawn into the grid texture with one geometry call from the atlas,
+    //! then the grid texture is presented. Without render targets or on SDL before 2.0.18 all quads
+    //! are copied one by one every frame instead. If no board changed, the frame is skipped unless force
+    //! is set. Returns true if a frame was presented
+    bool renderGrid(const std::vector<const BoardGame*> &games, bool force = false);
+    //! Position of board square represented by window coordinates {x, y} (as in mouse events)
+    Position squareAt(const int &x, const int &y) const;
+};
+
+#endif //SDLGAMETEST_BOARDRENDERER_H
@@ -0,0 +1,69 @@
+//
+// Headless AI versus AI games, see SelfPlay.h
+//
+
+#include "SelfPlay.h"
+
+#include <cassert>
+
+SelfPlay::SelfPlay(const BoardGameAIParams &white, const BoardGameAIParams &black) :
+    _white(&_mirror, white),
+    _black(&_game, black)
+{
+
+}
+
+void SelfPlay::reset()
+{
+    _game.resetGame();
+    _plies = 0;
+    _result = GameResult::IN_PROGRESS;
+    _stuck = false;
+}
+
+void SelfPlay::randomOpening(std::mt19937 &rng, int plies)
+{
+    for (int i = 0; i < plies; ++i)
+    {
+        auto moves = _game.legalMoves();
+        if (moves.empty())
+            return;
+        std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+        _game.makeMove(moves[pick(rng)]);
+        ++_plies;
+    }
+}
+
+bool SelfPlay::step()
+{
+    if (_result != GameResult::IN_PROGRESS || _stuck)
+        return false;
+    Move move;
+    if (_game.turnOrder() == SquareState::WHITE_PAWN)
+    {
+        _mirror.setMirrored(_game);
+        move = _white.getNextMove();
+        move = {BoardGame::mirrored(move.first), BoardGame::mirrored(move.second)};
+    }
+    else
+    {
+        move = _black.getNextMove();
+    }
+    if (!_game.makeMove(move))
+    {
+        // Games without legal moves are finished as draws, so AI always has one to make
+        assert(_game.legalMoves().empty());
+        _stuck = true;
+        return false;
+    }
+    ++_plies;
+    // Finished game is reset right away, result tells how it ended
+    _result = _game.lastResult();
+    return _result == GameResult::IN_PROGRESS;
+}
+
+GameResult SelfPlay::play(int maxPlies)
+{
+    while (_plies < maxPlies && step());
+    return _result;
+}
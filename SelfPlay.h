@@ -0,0 +1,55 @@
+//
+// Headless AI versus AI games for tuning and spectator mode.
+//
+
+#ifndef SDLGAMETEST_SELFPLAY_H
+#define SDLGAMETEST_SELFPLAY_H
+
+#include "BoardGame.h"
+#include "BoardGameAI.h"
+
+#include <random>
+
+//! Headless AI versus AI game.
+//! AI only plays black, so white moves are searched on a mirrored copy of the board
+class SelfPlay
+{
+    //! Game state
+    BoardGame _game;
+    //! Mirrored game state for white player
+    BoardGame _mirror;
+    //! White player, acts on _mirror
+    BoardGameAI _white;
+    //! Black player, acts on _game
+    BoardGameAI _black;
+    //! Moves made since game start
+    int _plies = 0;
+    //! Game result, IN_PROGRESS until the game is finished
+    GameResult _result = GameResult::IN_PROGRESS;
+    //! Set when player to move has no legal move
+    bool _stuck = false;
+
+public:
+    SelfPlay(const BoardGameAIParams &white, const BoardGameAIParams &black);
+    SelfPlay(const SelfPlay &) = delete;
+    SelfPlay &operator=(const SelfPlay &) = delete;
+
+    //! Starts a new game with the same players
+    void reset();
+    //! Plays given number of random legal moves to diversify starting positions
+    void randomOpening(std::mt19937 &rng, int plies);
+    //! Makes one AI move, returns false if the game is over or can't proceed
+    bool step();
+    //! Plays until the game is over or maxPlies moves are made, returns the result
+    GameResult play(int maxPlies);
+
+    //! Game state
+    const BoardGame &game() const { return _game; }
+    //! Game result, IN_PROGRESS until the game is finished
+    GameResult result() const { return _result; }
+    //! Moves made since game start
+    int plies() const { return _plies; }
+};
+
+
+#endif //SDLGAMETEST_SELFPLAY_H
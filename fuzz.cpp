@@ -0,0 +1,454 @@
+//
+// Fuzz target for BoardGame and BoardGameAI.
+// Input bytes are decoded into moves, search make/unmake, undo, redo, snapshots, crowded positions
+// and AI moves. After every operation game state invariants are checked, game results are compared
+// with ShadowGame, a naive model of the game rules, and on every reached position BoardGameAI must
+// choose the same move as ReferenceAI, the frozen original implementation.
+// Built with libFuzzer when SDLGAME_LIBFUZZER is defined, otherwise main() below feeds it
+// random inputs or inputs read from files.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "BoardGame.h"
+#include "BoardGameAI.h"
+#include "ReferenceAI.h"
+
+//! Reports failed check and aborts, so that libFuzzer saves the input
+static void check(bool condition, const char *message)
+{
+    if (condition)
+        return;
+    fprintf(stderr, "Check failed: %s\n", message);
+    abort();
+}
+
+static bool sameSnapshot(const GameSnapshot &a, const GameSnapshot &b)
+{
+    return memcmp(&a, &b, sizeof(GameSnapshot)) == 0;
+}
+
+static bool isStartPosition(const BoardGame &game)
+{
+    static const BoardGame start;
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            if (game.at({i, j}) != start.at({i, j}))
+                return false;
+        }
+    }
+    return game.turnOrder() == SquareState::WHITE_PAWN && !game.canUndo() && !game.canRedo();
+}
+
+//! Game rules written the slow and obvious way, reference for incremental draw detection in BoardGame.
+//! Keeps every position since the last history reset, including undone ones that can be redone
+class ShadowGame
+{
+    struct Ply
+    {
+        SquareState board[8][8];
+        SquareState turnOrder;
+        //! Move that led to this position
+        Move move;
+        //! Smallest total goal distance of white [0] and black [1] so far
+        int bestDistance[2];
+        //! Moves since either player reached a new smallest distance
+        int noProgress;
+    };
+    std::vector<Ply> _line;
+    //! Index of the current position in _line
+    size_t _current = 0;
+    //! Board for legal move enumeration
+    BoardGame _scratch;
+
+    //! Total steps pawns of side need to fill the opponent's 3x3 corner
+    static int distance(const Ply &ply, int side)
+    {
+        int total = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int j = 0; j < 8; ++j)
+            {
+                if (ply.board[i][j] == SquareState::WHITE_PAWN && side == 0)
+                    total += std::max(0, i - 2) + std::max(0, j - 2);
+                else if (ply.board[i][j] == SquareState::BLACK_PAWN && side == 1)
+                    total += std::max(0, 5 - i) + std::max(0, 5 - j);
+            }
+        }
+        return total;
+    }
+    static bool samePosition(const Ply &a, const Ply &b)
+    {
+        return a.turnOrder == b.turnOrder && memcmp(a.board, b.board, sizeof(a.board)) == 0;
+    }
+    //! Position reached by move from the current one
+    Ply next(const Move &move) const
+    {
+        Ply ply = _line[_current];
+        int side = ply.turnOrder == SquareState::BLACK_PAWN;
+        ply.board[move.second.x][move.second.y] = ply.board[move.first.x][move.first.y];
+        ply.board[move.first.x][move.first.y] = SquareState::EMPTY;
+        ply.turnOrder = side ? SquareState::WHITE_PAWN : SquareState::BLACK_PAWN;
+        ply.move = move;
+        int moverDistance = distance(ply, side);
+        if (moverDistance < ply.bestDistance[side])
+        {
+            ply.bestDistance[side] = moverDistance;
+            ply.noProgress = 0;
+        }
+        else
+        {
+            ++ply.noProgress;
+        }
+        return ply;
+    }
+    //! Expected result of the current position, reached by a move
+    GameResult evaluate()
+    {
+        const Ply &ply = _line[_current];
+        auto mover = ply.turnOrder == SquareState::WHITE_PAWN ? SquareState::BLACK_PAWN : SquareState::WHITE_PAWN;
+        if (distance(ply, mover == SquareState::BLACK_PAWN) == 0)
+            return mover == SquareState::WHITE_PAWN ? GameResult::WHITE_WON : GameResult::BLACK_WON;
+        // Positions count since the last progress, earlier ones can't come back
+        int repetitions = 0;
+        for (size_t i = _current + 1; i-- > 0;)
+        {
+            if (samePosition(_line[i], ply))
+                ++repetitions;
+            if (_line[i].noProgress == 0)
+                break;
+        }
+        if (repetitions >= BoardGame::REPETITION_LIMIT)
+            return GameResult::DRAW_REPETITION;
+        if (ply.noProgress >= BoardGame::NO_PROGRESS_LIMIT)
+            return GameResult::DRAW_NO_PROGRESS;
+        _scratch.setPosition(ply.board, ply.turnOrder);
+        if (_scratch.legalMoves().empty())
+            return GameResult::DRAW_NO_MOVES;
+        return GameResult::IN_PROGRESS;
+    }
+public:
+    //! Starts over from the position of game, as BoardGame does after reset or setPosition()
+    void reset(const BoardGame &game)
+    {
+        Ply ply = {};
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int j = 0; j < 8; ++j)
+                ply.board[i][j] = game.at({i, j});
+        }
+        ply.turnOrder = game.turnOrder();
+        ply.bestDistance[0] = distance(ply, 0);
+        ply.bestDistance[1] = distance(ply, 1);
+        _line.assign(1, ply);
+        _current = 0;
+    }
+    //! Forgets earlier positions, as BoardGame does in restore()
+    void dropHistory()
+    {
+        _line.assign(1, _line[_current]);
+        _current = 0;
+    }
+    //! Expected result of making move, discards undone moves
+    GameResult make(const Move &move)
+    {
+        auto ply = next(move);
+        _line.resize(_current + 1);
+        _line.push_back(ply);
+        ++_current;
+        return evaluate();
+    }
+    void undo() { --_current; }
+    //! Expected result of redoing the last undone move
+    GameResult redo()
+    {
+        auto ply = next(_line[_current + 1].move);
+        _line[++_current] = ply;
+        return evaluate();
+    }
+};
+
+//! Makes move with makeMove(), or with make() for search, and checks the outcome against shadow.
+//! Returns false if the move was rejected
+static bool play(BoardGame &game, ShadowGame &shadow, const Move &move, bool search)
+{
+    auto before = game.snapshot();
+    if (!(search ? game.make(move) : game.makeMove(move)))
+    {
+        check(sameSnapshot(before, game.snapshot()), "rejected move changed the game");
+        return false;
+    }
+    check(before.result == GameResult::IN_PROGRESS, "move was made in a finished game");
+    auto expected = shadow.make(move);
+    if (!search && expected != GameResult::IN_PROGRESS)
+    {
+        check(game.lastResult() == expected, "makeMove() reported wrong result");
+        check(isStartPosition(game), "finished game was not reset");
+        shadow.reset(game);
+        return true;
+    }
+    if (!search)
+        check(game.lastResult() == GameResult::IN_PROGRESS, "makeMove() reported a result for unfinished game");
+    check(game.result() == expected, "wrong game result");
+    check(game.turnOrder() != before.turnOrder, "turn did not pass to the other player");
+    check(game.canUndo(), "move can't be taken back");
+    return true;
+}
+
+//! Any move decoded from one byte: square in low 6 bits, direction in high 2 bits
+static Move decodeMove(uint8_t byte)
+{
+    Position directions[4] {{0,1},{1,0},{0,-1},{-1,0}};
+    Position from = {(byte & 63) / 8, byte & 7};
+    return {from, from + directions[byte >> 6]};
+}
+
+//! Legal move decoded from one byte, so that inputs reach deep positions.
+//! Falls back to decodeMove() when there are no legal moves
+static Move decodeLegalMove(const BoardGame &game, uint8_t byte)
+{
+    auto moves = game.legalMoves();
+    return moves.empty() ? decodeMove(byte) : moves[byte % moves.size()];
+}
+
+//! Bytes used by decodePosition()
+static const size_t POSITION_BYTES = 7;
+//! Random moves made by one burst operation
+static const int BURST_MOVES = 32;
+
+//! Crowded position decoded from bytes: 18 pawns packed along one board edge, 3 squares deep,
+//! so that pawns block each other and positions with few or no legal moves are common.
+//! First byte selects the edge, player taking action and number of gaps between pawns (0 to 6).
+//! Then 2 bits per square select gap, white or black until all pawns are placed
+static void decodePosition(const uint8_t *data, BoardGame &game)
+{
+    SquareState board[8][8] = {};
+    int edge = data[0] & 3;
+    int gaps = (data[0] >> 3) % 7;
+    int empty = 0, placed[3] = {0, 0, 0};
+    for (int k = 0; placed[1] + placed[2] < 18; ++k)
+    {
+        int across = k / 8, along = k % 8;
+        int line = edge & 1 ? 7 - across : across;
+        Position pos = edge & 2 ? Position{along, line} : Position{line, along};
+        int bits = (data[1 + k / 4] >> (k % 4 * 2)) & 3;
+        auto state = bits == 0 ? SquareState::EMPTY : bits & 1 ? SquareState::WHITE_PAWN : SquareState::BLACK_PAWN;
+        if (state == SquareState::EMPTY && empty == gaps)
+            state = bits & 2 ? SquareState::BLACK_PAWN : SquareState::WHITE_PAWN;
+        if (state != SquareState::EMPTY && placed[(int)state] == 9)
+            state = state == SquareState::WHITE_PAWN ? SquareState::BLACK_PAWN : SquareState::WHITE_PAWN;
+        ++placed[(int)state];
+        empty += state == SquareState::EMPTY;
+        board[pos.x][pos.y] = state;
+    }
+    game.setPosition(board, data[0] >> 2 & 1 ? SquareState::BLACK_PAWN : SquareState::WHITE_PAWN);
+}
+
+//! Compares BoardGameAI with reference orderings against ReferenceAI on the position.
+//! White positions are compared on a mirrored board, the way SelfPlay plays white
+static void compareAI(const BoardGame &game)
+{
+    static BoardGame scratch;
+    if (game.result() != GameResult::IN_PROGRESS)
+        return;
+    if (game.turnOrder() == SquareState::WHITE_PAWN)
+        scratch.setMirrored(game);
+    else
+        scratch.restore(game.snapshot());
+    BoardGameAI ai(&scratch, ReferenceAI::params());
+    ReferenceAI reference(&scratch);
+    check(ai.getNextMove() == reference.getNextMove(), "BoardGameAI move differs from ReferenceAI");
+}
+
+//! Checks invariants after an operation
+static void checkState(const BoardGame &game)
+{
+    check(game.consistent(), "pawn count, hash, bitboards or goal distances are inconsistent");
+    compareAI(game);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    BoardGame game;
+    ShadowGame shadow;
+    shadow.reset(game);
+    for (size_t i = 0; i < size; ++i)
+    {
+        // Ops 10 to 15 are AI moves, so that games often get finished
+        uint8_t op = data[i] & 15;
+        // Move operations take the following byte as the move
+        uint8_t arg = i + 1 < size ? data[i + 1] : 0;
+        auto before = game.snapshot();
+        switch (op)
+        {
+            case 0:
+            case 1:
+            {
+                // UI move, finished games are reset. Op 1 tries arbitrary, mostly illegal moves
+                ++i;
+                play(game, shadow, op == 0 ? decodeLegalMove(game, arg) : decodeMove(arg), false);
+                break;
+            }
+            case 2:
+            {
+                // Search move, finished games keep their final position
+                ++i;
+                play(game, shadow, decodeLegalMove(game, arg), true);
+                break;
+            }
+            case 3:
+            {
+                if (game.undo())
+                {
+                    shadow.undo();
+                    check(game.canRedo(), "undone move can't be redone");
+                    check(game.result() == GameResult::IN_PROGRESS, "undo kept the game finished");
+                }
+                break;
+            }
+            case 4:
+            {
+                if (game.redo())
+                    check(game.result() == shadow.redo(), "wrong game result after redo");
+                break;
+            }
+            case 5:
+            {
+                // Make and unmake must restore the exact state
+                ++i;
+                if (play(game, shadow, decodeLegalMove(game, arg), true))
+                {
+                    check(game.undo(), "made move can't be undone");
+                    shadow.undo();
+                    check(sameSnapshot(before, game.snapshot()), "make/undo didn't restore the game");
+                    check(game.redo(), "made move can't be redone");
+                    check(game.result() == shadow.redo(), "wrong game result after redo");
+                    check(game.undo(), "redone move can't be undone");
+                    shadow.undo();
+                    check(sameSnapshot(before, game.snapshot()), "redo/undo didn't restore the game");
+                }
+                break;
+            }
+            case 6:
+            {
+                // Snapshot restore must give the same state, also in another game
+                BoardGame copy;
+                copy.restore(before);
+                check(sameSnapshot(before, copy.snapshot()), "restored snapshot differs");
+                check(copy.hash() == game.hash(), "restored hash differs");
+                game.restore(before);
+                shadow.dropHistory();
+                check(!game.canUndo() && !game.canRedo(), "restore kept undo history");
+                break;
+            }
+            case 7:
+            {
+                // Crowded position, checks draws by lack of moves and blocked pawns near edges
+                if (i + POSITION_BYTES >= size)
+                    break;
+                decodePosition(data + i + 1, game);
+                i += POSITION_BYTES;
+                shadow.reset(game);
+                break;
+            }
+            case 8:
+            {
+                // Both players step away and back, repeating it ends in a draw by repetition
+                ++i;
+                auto first = decodeLegalMove(game, arg);
+                if (!play(game, shadow, first, false) || game.lastResult() != GameResult::IN_PROGRESS)
+                    break;
+                auto second = decodeLegalMove(game, arg >> 4);
+                if (!play(game, shadow, second, false) || game.lastResult() != GameResult::IN_PROGRESS)
+                    break;
+                // Steps back fail if the other player took the square
+                if (!play(game, shadow, {first.second, first.first}, false) || game.lastResult() != GameResult::IN_PROGRESS)
+                    break;
+                play(game, shadow, {second.second, second.first}, false);
+                break;
+            }
+            case 9:
+            {
+                // Random moves, long games without progress end in a draw
+                ++i;
+                std::minstd_rand rng(arg + 1);
+                for (int k = 0; k < BURST_MOVES; ++k)
+                {
+                    auto moves = game.legalMoves();
+                    if (moves.empty() || !play(game, shadow, moves[rng() % moves.size()], false)
+                        || game.lastResult() != GameResult::IN_PROGRESS)
+                        break;
+                }
+                break;
+            }
+            default:
+            {
+                // AI move for the player taking action, white plays on a mirrored board
+                if (game.result() != GameResult::IN_PROGRESS)
+                    break;
+                BoardGame mirrorGame;
+                Move move;
+                if (game.turnOrder() == SquareState::WHITE_PAWN)
+                {
+                    mirrorGame.setMirrored(game);
+                    move = BoardGameAI(&mirrorGame, ReferenceAI::params()).getNextMove();
+                    move = {BoardGame::mirrored(move.first), BoardGame::mirrored(move.second)};
+                }
+                else
+                {
+                    move = BoardGameAI(&game, ReferenceAI::params()).getNextMove();
+                }
+                // AI may be stuck when every pawn is blocked
+                play(game, shadow, move, false);
+                break;
+            }
+        }
+        checkState(game);
+    }
+    return 0;
+}
+
+#ifndef SDLGAME_LIBFUZZER
+//! Runs inputs from files given as arguments, or random inputs:
+//! SDLGameFuzz [runs [seed]]
+int main(int argc, char *args[])
+{
+    if (argc > 1 && args[1][0] && strspn(args[1], "0123456789") != strlen(args[1]))
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::ifstream in(args[i], std::ios::binary);
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(data.data(), data.size());
+        }
+        printf("%d inputs passed\n", argc - 1);
+        return 0;
+    }
+
+    int runs = argc > 1 ? atoi(args[1]) : 1000;
+    unsigned seed = argc > 2 ? (unsigned)strtoul(args[2], nullptr, 10) : 1;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> length(0, 2048);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<uint8_t> data;
+    for (int run = 0; run < runs; ++run)
+    {
+        data.resize(length(rng));
+        for (auto &value : data)
+            value = (uint8_t)byte(rng);
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    printf("%d random inputs passed\n", runs);
+    return 0;
+}
+#endif
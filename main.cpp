@@ -1,21 +1,42 @@
 #include <SDL.h>
 #include <SDL_image.h>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <random>
+#include <vector>
 
 #include "BoardGame.h"
 #include "BoardGameAI.h"
+#include "BoardRenderer.h"
+#include "SelfPlay.h"
 
-//Screen dimension constants
+//Initial screen dimension constants
 const int SCREEN_WIDTH = 480;
 const int SCREEN_HEIGHT = 480;
 
+//Spectator mode constants
+const int SPECTATOR_BOARDS = 64;
+//Random moves at the start of each spectated game, so that games differ
+const int SPECTATOR_OPENING_PLIES = 6;
+//Milliseconds per frame, 60 fps
+const Uint32 SPECTATOR_FRAME_TIME = 16;
+//Milliseconds per frame spent on AI moves
+const Uint32 SPECTATOR_AI_BUDGET = 8;
+//Milliseconds between frame time reports
+const Uint32 SPECTATOR_REPORT_TIME = 5000;
+
 //Starts up SDL and creates window
 bool init();
 
 //Frees media and shuts down SDL
 void close();
 
+//Shows a grid of AI versus AI games
+void spectate(int boards);
+
 //The window we'll be rendering to
 SDL_Window* gWindow = nullptr;
 //The window renderer
@@ -34,14 +55,16 @@ bool init()
     }
     else
     {
-        //Set texture filtering to linear
+        //Set texture filtering to linear. Textures are pre-scaled with it on resize, and when render
+        //targets are not supported the full-size textures are filtered on every frame instead
         if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
         {
             printf( "Warning: Linear texture filtering not enabled!" );
         }
 
         //Create window
-        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+        gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT,
+                                    SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI );
         if( gWindow == nullptr )
         {
             printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
@@ -88,6 +111,92 @@ void close()
     SDL_Quit();
 }
 
+void spectate(int boards)
+{
+    auto params = BoardGameAIParams::defaults();
+    std::mt19937 rng(std::random_device{}());
+    std::vector<std::unique_ptr<SelfPlay> > games;
+    std::vector<const BoardGame*> views;
+    for (int i = 0; i < boards; ++i)
+    {
+        games.emplace_back(new SelfPlay(params, params));
+        games.back()->randomOpening(rng, SPECTATOR_OPENING_PLIES);
+        views.push_back(&games.back()->game());
+    }
+    std::shared_ptr<BoardRenderer> renderer(new BoardRenderer(nullptr, gRenderer));
+
+    bool quit = false;
+    bool redraw = true;
+    size_t next = 0;
+    //Presented frames and time spent rendering them since the last report
+    int frames = 0;
+    double renderTime = 0;
+    Uint32 reportStart = SDL_GetTicks();
+    SDL_Event e;
+    while( !quit )
+    {
+        Uint32 frameStart = SDL_GetTicks();
+        while( SDL_PollEvent( &e ) != 0 )
+        {
+            if( e.type == SDL_QUIT )
+            {
+                quit = true;
+            }
+            else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+            {
+                renderer->resize();
+            }
+            else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_EXPOSED)
+            {
+                redraw = true;
+            }
+            else if (e.type == SDL_RENDER_TARGETS_RESET)
+            {
+                renderer->resize();
+                redraw = true;
+            }
+            else if (e.type == SDL_RENDER_DEVICE_RESET)
+            {
+                renderer->reload();
+                redraw = true;
+            }
+        }
+
+        //Advance games one move at a time in turns until AI time budget is spent
+        for (int moved = 0; moved < boards && SDL_GetTicks() - frameStart < SPECTATOR_AI_BUDGET; ++moved)
+        {
+            auto &game = games[next];
+            if (!game->step())
+            {
+                game->reset();
+                game->randomOpening(rng, SPECTATOR_OPENING_PLIES);
+            }
+            next = (next + 1) % games.size();
+        }
+
+        //Frame is skipped when no board changed
+        auto renderStart = std::chrono::steady_clock::now();
+        if (renderer->renderGrid(views, redraw))
+        {
+            ++frames;
+            renderTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+        }
+        redraw = false;
+
+        if (SDL_GetTicks() - reportStart >= SPECTATOR_REPORT_TIME)
+        {
+            printf("%d boards: %d frames, %.2f ms per frame\n", boards, frames, frames ? renderTime / frames : 0.0);
+            frames = 0;
+            renderTime = 0;
+            reportStart = SDL_GetTicks();
+        }
+
+        Uint32 elapsed = SDL_GetTicks() - frameStart;
+        if (elapsed < SPECTATOR_FRAME_TIME)
+            SDL_Delay(SPECTATOR_FRAME_TIME - elapsed);
+    }
+}
+
 int main( int argc, char* args[] )
 {
     //Start up SDL and create window
@@ -95,6 +204,11 @@ int main( int argc, char* args[] )
     {
         printf( "Failed to initialize!\n" );
     }
+    else if (argc > 1 && strcmp(args[1], "--spectate") == 0)
+    {
+        int boards = argc > 2 ? atoi(args[2]) : SPECTATOR_BOARDS;
+        spectate(boards > 0 ? boards : SPECTATOR_BOARDS);
+    }
     else
     {
         std::shared_ptr<BoardGame> game(new BoardGame);
@@ -118,6 +232,20 @@ int main( int argc, char* args[] )
                 {
                     quit = true;
                 }
+                else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                {
+                    renderer->resize();
+                }
+                else if (e.type == SDL_RENDER_TARGETS_RESET)
+                {
+                    //Pre-scaled textures are render targets and lose their contents
+                    renderer->resize();
+                }
+                else if (e.type == SDL_RENDER_DEVICE_RESET)
+                {
+                    //All textures are lost, including the ones loaded from files
+                    renderer->reload();
+                }
                 else if(e.type == SDL_KEYDOWN)
                 {
                     //Select surfaces based on key press
@@ -173,6 +301,15 @@ int main( int argc, char* args[] )
                         case SDLK_r:
                             game->resetGame();
                             break;
+
+                        // Undo and redo take back both AI response and player's move
+                        case SDLK_u:
+                            while (game->undo() && game->turnOrder() != SquareState::WHITE_PAWN);
+                            break;
+
+                        case SDLK_y:
+                            while (game->redo() && game->turnOrder() != SquareState::WHITE_PAWN);
+                            break;
                     }
                 }
                 else if (e.type == SDL_MOUSEMOTION)
@@ -0,0 +1,318 @@
+//
+// Headless AI parameter tuning with SPSA (simultaneous perturbation stochastic approximation).
+// Each AI ordering table is described by a weight per entry, the table is ordered by descending weight.
+// Every iteration plays a self-play match between two random perturbations of the weights
+// and moves the weights towards the winner.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BoardGameAI.h"
+#include "SelfPlay.h"
+
+//! Random moves made before AI takes over, so that deterministic AIs play different games
+const int OPENING_PLIES = 6;
+//! Safety limit on game length, draw rules normally finish games much sooner
+const int MAX_PLIES = 5000;
+//! SPSA perturbation size. Neighbouring table entries are 1.0 apart, so a perturbation
+//! of 0.75 swaps neighbours perturbed in opposite directions and leaves other entries in place
+const double PERTURBATION = 0.75;
+//! Weight change of the first iterations for an average match result, used to calibrate gain.
+//! Larger steps let noise of single matches reorder the tables faster than they improve
+const double INITIAL_STEP = 0.1;
+//! Matches played to measure average match result before tuning
+const int CALIBRATION_MATCHES = 8;
+//! Openings played against defaults at checkpoints, more than in a tuning match to pick the best tables reliably
+const int EVALUATION_OPENINGS = 64;
+
+//! Tuning settings, see usage()
+struct Options
+{
+    int iterations = 200;
+    int openings = 16;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int checkpointEvery = 10;
+    unsigned seed = 1;
+    std::string checkpoint = "tune.checkpoint";
+    std::string output = "BoardGameAITables.h";
+};
+
+//! Tuner state saved to checkpoint file
+struct TuneState
+{
+    int iteration = 0;
+    double bestScore = 0.5;
+    //! SPSA gain, calibrated on start
+    double gain = 0;
+    std::vector<double> theta;
+    std::vector<double> bestTheta;
+};
+
+//! Weights that reproduce default orderings
+static std::vector<double> defaultTheta()
+{
+    std::vector<double> theta;
+    for (int size : {9, 9, 4, 2})
+    {
+        for (int i = 0; i < size; ++i)
+            theta.push_back(size - i);
+    }
+    return theta;
+}
+
+//! Orders default table entries by descending weights starting from theta[offset]
+template<size_t N>
+static std::array<Position, N> ordered(const std::array<Position, N> &table, const std::vector<double> &theta, size_t offset)
+{
+    std::array<size_t, N> index;
+    std::iota(index.begin(), index.end(), 0);
+    std::stable_sort(index.begin(), index.end(), [&](size_t a, size_t b) {
+        return theta[offset + a] > theta[offset + b];
+    });
+    std::array<Position, N> result;
+    for (size_t i = 0; i < N; ++i)
+        result[i] = table[index[i]];
+    return result;
+}
+
+static BoardGameAIParams toParams(const std::vector<double> &theta)
+{
+    auto defaults = BoardGameAIParams::defaults();
+    BoardGameAIParams params;
+    params.destPriority = ordered(defaults.destPriority, theta, 0);
+    params.leavePriority = ordered(defaults.leavePriority, theta, 9);
+    params.stepPriority = ordered(defaults.stepPriority, theta, 18);
+    params.leaveSteps = ordered(defaults.leaveSteps, theta, 22);
+    return params;
+}
+
+//! Score of player a against player b, from 0 (all lost) to 1 (all won).
+//! Each random opening is played twice with swapped colors, games are spread across threads
+static double match(const BoardGameAIParams &a, const BoardGameAIParams &b, int openings, unsigned seed, int threads)
+{
+    int games = openings * 2;
+    std::vector<double> scores(games);
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        for (int i = next++; i < games; i = next++)
+        {
+            bool aWhite = i % 2 == 0;
+            std::mt19937 rng(seed + i / 2);
+            SelfPlay game(aWhite ? a : b, aWhite ? b : a);
+            game.randomOpening(rng, OPENING_PLIES);
+            auto result = game.play(MAX_PLIES);
+            if (result == GameResult::WHITE_WON)
+                scores[i] = aWhite ? 1.0 : 0.0;
+            else if (result == GameResult::BLACK_WON)
+                scores[i] = aWhite ? 0.0 : 1.0;
+            else
+                scores[i] = 0.5;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &thread : pool)
+        thread.join();
+    return std::accumulate(scores.begin(), scores.end(), 0.0) / games;
+}
+
+//! Plays theta perturbed by ck in random directions against theta perturbed in opposite directions.
+//! Returns directions and score difference of the perturbations, in [-1, 1]
+static double perturbedMatch(const std::vector<double> &theta, double ck, std::mt19937 &rng, const Options &options, std::vector<double> &delta)
+{
+    std::bernoulli_distribution coin;
+    std::vector<double> plus(theta), minus(theta);
+    delta.resize(theta.size());
+    for (size_t i = 0; i < delta.size(); ++i)
+    {
+        delta[i] = coin(rng) ? 1.0 : -1.0;
+        plus[i] += ck * delta[i];
+        minus[i] -= ck * delta[i];
+    }
+    return 2.0 * match(toParams(plus), toParams(minus), options.openings, rng(), options.threads) - 1.0;
+}
+
+static bool loadCheckpoint(const std::string &path, TuneState &state)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    size_t size = defaultTheta().size();
+    state.theta.resize(size);
+    state.bestTheta.resize(size);
+    in >> state.iteration >> state.bestScore >> state.gain;
+    for (auto &w : state.theta)
+        in >> w;
+    for (auto &w : state.bestTheta)
+        in >> w;
+    return (bool)in;
+}
+
+static void saveCheckpoint(const std::string &path, const TuneState &state)
+{
+    // Write to temporary file first so that interrupted tuning doesn't corrupt the checkpoint
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp);
+        out.precision(17);
+        out << state.iteration << ' ' << state.bestScore << ' ' << state.gain << '\n';
+        for (auto w : state.theta)
+            out << w << ' ';
+        out << '\n';
+        for (auto w : state.bestTheta)
+            out << w << ' ';
+        out << '\n';
+    }
+    std::rename(tmp.c_str(), path.c_str());
+}
+
+template<size_t N>
+static void writeTable(std::ofstream &out, const char *comment, const char *name, const std::array<Position, N> &table)
+{
+    out << "    //! " << comment << '\n';
+    out << "    constexpr Position " << name << '[' << N << "] = {";
+    for (size_t i = 0; i < N; ++i)
+        out << (i ? "," : "") << '{' << table[i].x << ',' << table[i].y << '}';
+    out << "};\n";
+}
+
+//! Writes orderings as a drop-in replacement for BoardGameAITables.h
+static bool writeHeader(const std::string &path, const BoardGameAIParams &params, const TuneState &state)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << "//\n";
+    out << "// Generated by SDLGameTune after " << state.iteration << " iterations, score against defaults: " << state.bestScore << ".\n";
+    out << "// SDLGameTune writes tuned tables in the same format, replace this file with its output to use them.\n";
+    out << "//\n\n";
+    out << "#ifndef SDLGAMETEST_BOARDGAMEAITABLES_H\n#define SDLGAMETEST_BOARDGAMEAITABLES_H\n\n";
+    out << "#include \"BoardGame.h\"\n\n";
+    out << "namespace BoardGameAITables\n{\n";
+    writeTable(out, "Destination squares in order of priority", "DEST_PRIORITY", params.destPriority);
+    writeTable(out, "Start squares in order of leave priority", "LEAVE_PRIORITY", params.leavePriority);
+    writeTable(out, "Pawn steps in order of preference, the last two are only used to unblock the game", "STEP_PRIORITY", params.stepPriority);
+    writeTable(out, "Steps used to leave start area in order of preference", "LEAVE_STEPS", params.leaveSteps);
+    out << "}\n\n#endif //SDLGAMETEST_BOARDGAMEAITABLES_H\n";
+    return (bool)out;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+           "  -i <n>     SPSA iterations (default 200)\n"
+           "  -g <n>     random openings per match, each played with both colors (default 16)\n"
+           "  -j <n>     worker threads (default: hardware concurrency)\n"
+           "  -k <n>     checkpoint and evaluation interval in iterations (default 10)\n"
+           "  -s <n>     random seed (default 1)\n"
+           "  -c <path>  checkpoint file, tuning resumes from it if present (default tune.checkpoint)\n"
+           "  -o <path>  generated header (default BoardGameAITables.h)\n", name);
+}
+
+static bool parseOptions(int argc, char *args[], Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 >= argc || args[i][0] != '-' || strlen(args[i]) != 2)
+            return false;
+        const char *value = args[++i];
+        switch (args[i - 1][1])
+        {
+            case 'i': options.iterations = atoi(value); break;
+            case 'g': options.openings = std::max(1, atoi(value)); break;
+            case 'j': options.threads = std::max(1, atoi(value)); break;
+            case 'k': options.checkpointEvery = std::max(1, atoi(value)); break;
+            case 's': options.seed = (unsigned)strtoul(value, nullptr, 10); break;
+            case 'c': options.checkpoint = value; break;
+            case 'o': options.output = value; break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *args[])
+{
+    Options options;
+    if (!parseOptions(argc, args, options))
+    {
+        usage(args[0]);
+        return 1;
+    }
+
+    TuneState state;
+    if (loadCheckpoint(options.checkpoint, state))
+    {
+        printf("Resuming from %s at iteration %d\n", options.checkpoint.c_str(), state.iteration);
+    }
+    else
+    {
+        state = TuneState();
+        state.theta = defaultTheta();
+        state.bestTheta = state.theta;
+    }
+
+    // Gain sequences as recommended by Spall
+    const double c = PERTURBATION, A = options.iterations * 0.1, alpha = 0.602, gamma = 0.101;
+    const auto defaults = BoardGameAIParams::defaults();
+    std::mt19937 rng(options.seed + state.iteration);
+    std::vector<double> delta;
+
+    if (state.gain <= 0)
+    {
+        // Weights change by ak * |diff| / (2 * ck) per iteration. Gain is chosen so that
+        // the first iterations change them by INITIAL_STEP for an average |diff|
+        double sum = 0;
+        for (int i = 0; i < CALIBRATION_MATCHES; ++i)
+            sum += std::fabs(perturbedMatch(state.theta, c, rng, options, delta));
+        double meanDiff = std::max(sum / CALIBRATION_MATCHES, 0.01);
+        state.gain = INITIAL_STEP * 2.0 * c * std::pow(1 + A, alpha) / meanDiff;
+        printf("Average match result difference %.3f, gain %.3f\n", meanDiff, state.gain);
+    }
+
+    while (state.iteration < options.iterations)
+    {
+        int k = state.iteration;
+        double ak = state.gain / std::pow(k + 1 + A, alpha);
+        double ck = c / std::pow(k + 1, gamma);
+
+        double diff = perturbedMatch(state.theta, ck, rng, options, delta);
+        for (size_t i = 0; i < delta.size(); ++i)
+            state.theta[i] += ak * diff / (2.0 * ck * delta[i]);
+        ++state.iteration;
+
+        if (state.iteration % options.checkpointEvery == 0 || state.iteration == options.iterations)
+        {
+            // Fixed seed keeps evaluations comparable between checkpoints
+            double score = match(toParams(state.theta), defaults, EVALUATION_OPENINGS, options.seed, options.threads);
+            printf("Iteration %d: score against defaults %.3f (best %.3f)\n", state.iteration, score, state.bestScore);
+            if (score > state.bestScore)
+            {
+                state.bestScore = score;
+                state.bestTheta = state.theta;
+            }
+            saveCheckpoint(options.checkpoint, state);
+        }
+    }
+
+    if (!writeHeader(options.output, toParams(state.bestTheta), state))
+    {
+        printf("Unable to write %s\n", options.output.c_str());
+        return 1;
+    }
+    printf("Best tables written to %s\n", options.output.c_str());
+    return 0;
+}